@@ -128,6 +128,10 @@ WITH_CLEANMEM ?= 0
   # This does not improve the performance or memory consumption of any application in any way
   # and may even increase the code size and reduce performance.
   # Use this option for debugging your code for memory leaks with 'valgrind' and friends.
+WITH_PROFILE_LOCKS ?= 0
+  # Instrument all 'CMutex' and 'CCond' operations to record contention counts, waiting and
+  # holding times. A report is logged on SIGUSR2 and can be retrieved by the shell's 'locks' command.
+  # This adds a noticable overhead to each lock operation and is meant for performance analysis only.
 
 
 # C/C++ Setting: Resources-specific features ...
@@ -253,6 +257,7 @@ $(DIR_OBJ)/%-pic.o: %.C
 # C/C++ Setting: General...
 CFG_H_CONTENT := "\n\#define WITH_DEBUG" $(WITH_DEBUG)
 CFG_H_CONTENT += "\n\#define WITH_CLEANMEM" $(WITH_CLEANMEM)
+CFG_H_CONTENT += "\n\#define WITH_PROFILE_LOCKS" $(WITH_PROFILE_LOCKS)
 
 # C/C++ Setting: Resources...
 CFG_H_CONTENT += "\n"
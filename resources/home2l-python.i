@@ -76,6 +76,7 @@
 // Types that need to be handled specially...
 typedef long long TTicks;     // should be 'int64_t'; "#include <stdint.h>" apparently does not work
 typedef long long TTicks;  // should be 'int32_t'
+typedef unsigned int uint32_t;    // trace IDs
 # ~ typedef int TTicks;  // should be 'int32_t'
 
 
@@ -1107,6 +1108,7 @@ import atexit
 
 _home2lStarted = False
 _home2lStopped = False
+_home2lException = None   # first exception raised by a callback function in the current 'Home2lIterate()'
 
 %}
 %feature("pythonappend") Home2lInit %{
@@ -1196,6 +1198,103 @@ static inline void Home2lInit (const char *instance = NULL, bool server = false,
 %}
 
 
+%feature("docstring") Home2lFetchEvents "Wait for and fetch all pending events of all event processors.\n\n"
+  "Waits for at most 'maxTime' ms (forever if 'maxTime < 0') until events are\n"
+  "available and returns up to 'maxEvents' events as a list of tuples\n"
+  "'(epType, epInstId, events)', one for each event processor with pending\n"
+  "events. 'events' is a list of tuples '(evType, resource, valueState)'.\n"
+  "The GIL is released while waiting, so that other Python threads can run.\n"
+%nothread Home2lFetchEvents;
+%inline %{
+static inline PyObject *Home2lFetchEvents (TTicks maxTime = 0, int maxEvents = 256) {
+  static PyObject *rcWrappers = NULL;   // cache of resource wrapper objects (resource objects are never deleted)
+  CRcEventProcessor *ep, **epList;
+  CRcEvent *evList, *ev;
+  CRcValueState *vs;
+  PyObject *ret, *batch, *pyRc, *pyVs, *key, *item;
+  int events, n, k, i;
+  bool ok;
+
+  // Fetch events without holding the GIL ...
+  if (maxEvents < 1) maxEvents = 1;
+  evList = new CRcEvent [maxEvents];
+  epList = MALLOC (CRcEventProcessor *, maxEvents);
+  events = 0;
+  Py_BEGIN_ALLOW_THREADS
+  ep = CRcEventProcessor::Select (maxTime);
+  while (ep && events < maxEvents) {
+    while (events < maxEvents && ep->PollEvent (&evList[events])) epList[events++] = ep;
+    ep = (events < maxEvents) ? CRcEventProcessor::Select (0) : NULL;
+  }
+  Py_END_ALLOW_THREADS
+
+  // Build the result (one entry per sequence of events of the same processor) ...
+  //   On failure, a Python exception is set by the failing call, and NULL is returned.
+  if (!rcWrappers) rcWrappers = PyDict_New ();
+  ret = PyList_New (0);
+  ok = (rcWrappers != NULL && ret != NULL);
+  for (n = 0; n < events && ok; n = k) {
+    ep = epList[n];
+    for (k = n; k < events && epList[k] == ep; k++);
+    batch = PyList_New (k - n);
+    if (!batch) { ok = false; break; }
+    for (i = n; i < k && ok; i++) {
+      ev = &evList[i];
+
+      // Get resource wrapper (new reference) ...
+      if (!ev->Resource ()) {
+        pyRc = Py_None;
+        Py_INCREF (pyRc);
+      }
+      else {
+        pyRc = NULL;
+        key = PyLong_FromVoidPtr (ev->Resource ());
+        if (key) {
+          pyRc = PyDict_GetItem (rcWrappers, key);    // borrowed reference
+          if (pyRc) Py_INCREF (pyRc);
+          else {
+            pyRc = SWIG_NewPointerObj (SWIG_as_voidptr (ev->Resource ()), SWIGTYPE_p_CResource, 0);
+            if (pyRc) if (PyDict_SetItem (rcWrappers, key, pyRc) < 0) Py_CLEAR (pyRc);
+          }
+          Py_DECREF (key);
+        }
+      }
+
+      // Create value state object owned by Python (new reference) ...
+      pyVs = NULL;
+      if (pyRc) {
+        vs = new CRcValueState (ev->ValueState ());
+        pyVs = SWIG_NewPointerObj (SWIG_as_voidptr (vs), SWIGTYPE_p_CRcValueState, SWIG_POINTER_OWN);
+        if (!pyVs) delete vs;
+      }
+
+      // Create event tuple ...
+      item = (pyRc && pyVs) ? Py_BuildValue ("(iOO)", (int) ev->Type (), pyRc, pyVs) : NULL;
+      Py_XDECREF (pyRc);
+      Py_XDECREF (pyVs);
+      if (item) PyList_SET_ITEM (batch, i - n, item);    // steals the reference to 'item'
+      else ok = false;
+    }
+    if (ok) {
+      item = Py_BuildValue ("(ssO)", ep->TypeId (), ep->InstId (), batch);
+      if (!item) ok = false;
+      else {
+        if (PyList_Append (ret, item) < 0) ok = false;
+        Py_DECREF (item);
+      }
+    }
+    Py_DECREF (batch);    // a partially filled list can be released safely
+  }
+
+  // Done ...
+  delete [] evList;
+  free (epList);
+  if (!ok) Py_CLEAR (ret);
+  return ret;
+}
+%}
+
+
 %feature("docstring") Home2lDone "Shutdown the Home2L package.\n\n"
   "It is not necessary to call this as the last command in a script, since it\n"
   "is executed automatically on exit.\n"
@@ -1211,6 +1310,7 @@ static inline void Home2lDone () {
 
 
 import signal
+import traceback
 
 
 ## End the elaboration and start the background activities of the Home2L package.
@@ -1242,9 +1342,12 @@ def Home2lIterate (maxTime = 0):
   If 'maxTime == 0', only the currently pending work is done, and the\n\
   function does not wait. If 'maxTime < 0', the function may wait\n\
   indefinitely (this feature is used by 'Run').\n\
+  \n\
+  If a callback function raises an exception, the remaining fetched events\n\
+  are still dispatched, and the first exception is re-raised afterwards.\n\
   """
   # ~ print ("### Home2lIterate()")
-  global _home2lStarted
+  global _home2lStarted, _home2lException
   if not _home2lStarted: Home2lStart ()      # implicitly end the elaboration phase if not done yet
 
   # Switch off the Python-internal Ctrl-C handler while waiting ...
@@ -1253,88 +1356,109 @@ def Home2lIterate (maxTime = 0):
   if maxTime != 0:
     s = signal.getsignal (signal.SIGINT)
     signal.signal (signal.SIGINT, signal.SIG_DFL)
-  ep = CRcEventProcessor.Select (maxTime);
+  batches = Home2lFetchEvents (maxTime)
   if maxTime != 0:
     signal.signal (signal.SIGINT, s)
-  # ~ print ("### Home2lIterate(): Select done")
+  # ~ print ("### Home2lIterate(): Fetch done")
 
-  # Return if no event available ...
-  if not ep: return
-  ev = ep.PollEvent ()
-  if not ev: return
-  epType = ep.TypeId ()
-  epLid = ep.InstId ()
-  # ~ print ("### Home2lIterate(): Event: ", epType, epLid);
+  # Process events ...
+  _home2lException = None
+  for epType, epLid, events in batches:
+    _Home2lDispatch (epType, epLid, events)
+
+  # Re-raise the first exception of a callback (if any) ...
+  if _home2lException != None:
+    e = _home2lException
+    _home2lException = None
+    raise e
+
+
+def _Home2lCall (func, *args, **kwargs):
+  # Run a callback function. An exception does not prevent the remaining events
+  # from being dispatched: The first one is kept and re-raised by 'Home2lIterate()'
+  # after all events have been dispatched, further ones are only reported.
+  global _home2lException
+  try:
+    func (*args, **kwargs)
+  except Exception as e:
+    if _home2lException == None: _home2lException = e
+    else: traceback.print_exc ()
+
+
+def _Home2lDispatch (epType, epLid, events):
+  # ~ print ("### _Home2lDispatch(): Events: ", epType, epLid, len (events));
+  #
+  # Note: A batch may contain events for several endpoints, and a callback may
+  #   have removed (e.g. cancelled) an endpoint with events still pending in the batch.
+  #   Such stale events are ignored.
 
-  # Process event ...
   if epType == 'S':     # Subscriber...
 
     # Check 'RunOnEvent'...
     if epLid in _onEventDict:
       func, subscr, data = _onEventDict[epLid]
-      while ev:     # loop to quickly process many events
+      for evType, rc, vs in events:
         if func.__code__.co_argcount == 3:     # tolerate functions without the 'data' argument ...
-          func (ev.Type (), ev.Resource (), ev.ValueState ())
+          _Home2lCall (func, evType, rc, vs)
         else:
-          func (ev.Type (), ev.Resource (), ev.ValueState (), data)
-        ev = ep.PollEvent ()
+          _Home2lCall (func, evType, rc, vs, data)
 
     # Check 'RunOnUpdate'...
     elif epLid in _onUpdateDict:
       func, subscr, rcList, funcArgs, data = _onUpdateDict[epLid]
-      lastEv = None
-      while ev:
-        if ev.Type () == rceValueStateChanged: lastEv = ev
-        ev = ep.PollEvent ()
-      if lastEv:
-        argList = []
-        # ~ print ("### rcList = " + str(rcList))
-        for rc in rcList: argList.append (rc.Value ())
-        if funcArgs != None or data != None: argList.append (data)
-          # If the function arguments are variable (as in '_OnUpdateFunc()' in 'Connect()'),
-          # we add the 'data' argument iff it is != 'None'. Otherwise, we pass as many
-          # arguments as 'func' takes.
-        if funcArgs != None: del argList[funcArgs:]     # tolerate functions with fewer arguments ...
-        # ~ print ("### Home2lIterate() on update: funcArgs = " + str(funcArgs) + ", argList = " + str(argList))
-        func (*argList)
+      for evType, rc, vs in events:
+        if evType == rceValueStateChanged: break
+      else:
+        return
+      argList = []
+      # ~ print ("### rcList = " + str(rcList))
+      for rc in rcList: argList.append (rc.Value ())
+      if funcArgs != None or data != None: argList.append (data)
+        # If the function arguments are variable (as in '_OnUpdateFunc()' in 'Connect()'),
+        # we add the 'data' argument iff it is != 'None'. Otherwise, we pass as many
+        # arguments as 'func' takes.
+      if funcArgs != None: del argList[funcArgs:]     # tolerate functions with fewer arguments ...
+      # ~ print ("### _Home2lDispatch() on update: funcArgs = " + str(funcArgs) + ", argList = " + str(argList))
+      _Home2lCall (func, *argList)
 
     # Check 'RunDaily'...
     elif epLid in _dailyDict:
       func, subscr, data = _dailyDict[epLid]
       hostSet = set()
-      while ev:
-        if ev.Type () == rceValueStateChanged or ev.Type () == rceConnected:
-          host = ev.Resource ().Uri ().split ('/') [2]
+      for evType, rc, vs in events:
+        if evType == rceValueStateChanged or evType == rceConnected:
+          host = rc.Uri ().split ('/') [2]
           hostSet.add (host)
-        ev = ep.PollEvent ()
       for host in hostSet:
-        if func.__code__.co_argcount == 0:   func ()
-        elif func.__code__.co_argcount == 1: func (host)
-        else:                                func (host, data)
+        if func.__code__.co_argcount == 0:   _Home2lCall (func)
+        elif func.__code__.co_argcount == 1: _Home2lCall (func, host)
+        else:                                _Home2lCall (func, host, data)
     else:
       print ("WARNING: Received event on unknown subscriber '" + epLid + "'")
 
   # Driver (driving) ...
   elif epType == 'D':
+    if not epLid in _driverDict: return     # driver has been removed meanwhile
     func, data = _driverDict[epLid]
-    if func == None:
-      print ("WARNING: Received drive event for '" + str (ev.Resource ()) + "', but driver has no drive function.")
-    else:
-      if func.__code__.co_argcount == 2:     # tolerate functions without the 'data' argument ...
-        func (ev.Resource (), ev.ValueState ())
+    for evType, rc, vs in events:
+      if func == None:
+        print ("WARNING: Received drive event for '" + str (rc) + "', but driver has no drive function.")
+      elif func.__code__.co_argcount == 2:     # tolerate functions without the 'data' argument ...
+        _Home2lCall (func, rc, vs)
       else:
-        func (ev.Resource (), ev.ValueState (), data)
+        _Home2lCall (func, rc, vs, data)
 
   # Timer ('RunAt') ...
   elif epType == 'T':
-    # ~ print ("### Home2lIterate(): Timer '" + epLid + "'")
+    # ~ print ("### _Home2lDispatch(): Timer '" + epLid + "'")
+    if not epLid in _timerDict: return      # timer has been cancelled meanwhile
     func, args, ep = _timerDict[epLid]
-    if func.__code__.co_argcount == 0:    func ()       # tolerate functions without an argument
-    elif func.__code__.co_argcount == 1:  func (args)   # single argument: pass unchecked
-    elif isinstance (args, tuple):        func (*args)  # call with positional arguments
-    elif isinstance (args, dict):         func (**args) # call with keyword arguments
-    else:                                 func (args)   # call unchanged (this may fail, but will hopefully give a meaningful exception report)
-    while ev: ev = ep.PollEvent ()  # Ignore overflown timer events
+    if func.__code__.co_argcount == 0:    _Home2lCall (func)          # tolerate functions without an argument
+    elif func.__code__.co_argcount == 1:  _Home2lCall (func, args)    # single argument: pass unchecked
+    elif isinstance (args, tuple):        _Home2lCall (func, *args)   # call with positional arguments
+    elif isinstance (args, dict):         _Home2lCall (func, **args)  # call with keyword arguments
+    else:                                 _Home2lCall (func, args)    # call unchanged (this may fail, but will hopefully give a meaningful exception report)
+    # Overflown timer events are ignored.
 
 
 ## Run the Home2L main loop indefinitely (or until stopped).